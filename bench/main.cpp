@@ -0,0 +1,456 @@
+#include "../docker_internal.h"
+#include "rapidjson/stringbuffer.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <fstream>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+#include <string>
+#include <vector>
+
+/*
+*
+* Offline microbenchmarks for the client's hot paths.
+*
+* Nothing here talks to a Docker daemon: every benchmark runs against
+* deterministic in-memory fixtures shaped like real Engine API responses.
+*
+* Usage: docker-bench [--json <file>] [--filter <substr>] [--min-time <ms>] [--large]
+*
+*/
+
+/*
+* Allocation accounting
+*
+* On glibc the allocator entry points are interposed so that every malloc made
+* by the library, libstdc++ (operator new) and RapidJSON is counted.  Elsewhere
+* the allocation columns are reported as -1.
+*
+* malloc/calloc add their full size.  realloc counts as one allocation but only
+* adds the bytes it grows the block by, so buffers that grow in place aren't
+* charged their whole size again on every step.
+*/
+#if defined(__GLIBC__)
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void  __libc_free(void* ptr);
+}
+
+static uint64_t g_alloc_count = 0;
+static uint64_t g_alloc_bytes = 0;
+
+extern "C" void* malloc(size_t size){
+    ++g_alloc_count;
+    g_alloc_bytes += size;
+    return __libc_malloc(size);
+}
+extern "C" void* calloc(size_t count, size_t size){
+    ++g_alloc_count;
+    g_alloc_bytes += count * size;
+    return __libc_calloc(count, size);
+}
+extern "C" void* realloc(void* ptr, size_t size){
+    size_t old_size = ptr ? malloc_usable_size(ptr) : 0;
+    ++g_alloc_count;
+    g_alloc_bytes += size > old_size ? size - old_size : 0;
+    return __libc_realloc(ptr, size);
+}
+extern "C" void free(void* ptr){
+    __libc_free(ptr);
+}
+static const bool kCountsAllocations = true;
+#else
+static uint64_t g_alloc_count = 0;
+static uint64_t g_alloc_bytes = 0;
+static const bool kCountsAllocations = false;
+#endif
+
+// Results are folded into this so the optimizer can't drop the measured work
+static volatile uint64_t g_sink = 0;
+
+/*
+* Fixtures
+*/
+
+// Small fixed-seed generator so fixtures are identical across runs and machines
+class FixtureRng{
+    public :
+        explicit FixtureRng(uint64_t seed) : state(seed){}
+        uint32_t next(){
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            return (uint32_t)(state >> 33);
+        }
+        std::string hex(size_t length){
+            static const char digits[] = "0123456789abcdef";
+            std::string out(length, '0');
+            for (size_t i = 0; i < length; i++) {
+                out[i] = digits[next() & 0xf];
+            }
+            return out;
+        }
+    private:
+        uint64_t state;
+};
+
+// Body of GET /containers/json?all=true&size=true for `count` containers
+static std::string make_containers_json(size_t count){
+    FixtureRng rng(0xd0c4e7 + count);
+    static const char* images[] = {"ubuntu:22.04", "nginx:1.25-alpine", "postgres:16", "redis:7", "registry.example.com/team/service:2024.10.3"};
+    static const char* states[] = {"running", "exited", "created", "paused"};
+
+    std::string out;
+    out.reserve(count * 1400);
+    out += "[";
+    for (size_t i = 0; i < count; i++) {
+        const char* image = images[rng.next() % 5];
+        const char* state = states[rng.next() % 4];
+        char number[32];
+        if (i) out += ",";
+        out += "{\"Id\":\"" + rng.hex(64) + "\"";
+        snprintf(number, sizeof(number), "%zu", i);
+        out += ",\"Names\":[\"/worker-" + std::string(number) + "\"]";
+        out += ",\"Image\":\"" + std::string(image) + "\"";
+        out += ",\"ImageID\":\"sha256:" + rng.hex(64) + "\"";
+        out += ",\"Command\":\"/docker-entrypoint.sh --config /etc/service/config.yaml --verbose\"";
+        snprintf(number, sizeof(number), "%u", 1700000000u + rng.next() % 10000000u);
+        out += ",\"Created\":" + std::string(number);
+        out += ",\"Ports\":[{\"IP\":\"0.0.0.0\",\"PrivatePort\":8080,\"PublicPort\":" + std::to_string(30000 + rng.next() % 20000) + ",\"Type\":\"tcp\"}]";
+        out += ",\"SizeRw\":" + std::to_string(rng.next() % 100000000u);
+        out += ",\"SizeRootFs\":" + std::to_string(rng.next());
+        out += ",\"Labels\":{\"com.docker.compose.project\":\"control-plane\",\"com.docker.compose.service\":\"worker\",\"com.example.build\":\"" + rng.hex(12) + "\"}";
+        out += ",\"State\":\"" + std::string(state) + "\"";
+        out += ",\"Status\":\"Up 3 hours (healthy)\"";
+        out += ",\"HostConfig\":{\"NetworkMode\":\"bridge\"}";
+        out += ",\"NetworkSettings\":{\"Networks\":{\"bridge\":{\"IPAMConfig\":null,\"Links\":null,\"Aliases\":null,\"NetworkID\":\"" + rng.hex(64) + "\",\"EndpointID\":\"" + rng.hex(64) + "\",\"Gateway\":\"172.17.0.1\",\"IPAddress\":\"172.17." + std::to_string(rng.next() % 256) + "." + std::to_string(rng.next() % 256) + "\",\"IPPrefixLen\":16,\"IPv6Gateway\":\"\",\"GlobalIPv6Address\":\"\",\"GlobalIPv6PrefixLen\":0,\"MacAddress\":\"02:42:ac:11:00:02\"}}}";
+        out += ",\"Mounts\":[{\"Type\":\"volume\",\"Name\":\"" + rng.hex(64) + "\",\"Source\":\"\",\"Destination\":\"/var/lib/data\",\"Driver\":\"local\",\"Mode\":\"z\",\"RW\":true,\"Propagation\":\"\"}]";
+        out += "}";
+    }
+    out += "]";
+    return out;
+}
+
+// Multiplexed stdout/stderr stream as returned by GET /containers/{id}/logs
+static std::string make_multiplexed_logs(size_t target_bytes){
+    FixtureRng rng(0x10c5 + target_bytes);
+    std::string out;
+    out.reserve(target_bytes + 256);
+    std::string line;
+    while (out.size() < target_bytes) {
+        line = "2024-10-18T12:00:00.000000000Z level=info msg=\"request handled\" trace=" + rng.hex(16);
+        line.append(rng.next() % 96, 'x');
+        line += "\n";
+
+        uint32_t length = (uint32_t)line.size();
+        char header[8] = {(char)((rng.next() % 5 == 0) ? 2 : 1), 0, 0, 0,
+                          (char)(length >> 24), (char)(length >> 16), (char)(length >> 8), (char)length};
+        out.append(header, 8);
+        out += line;
+    }
+    return out;
+}
+
+/*
+* Runner
+*/
+
+struct BenchResult{
+    std::string name;
+    uint64_t iterations;
+    uint64_t bytes_processed;    // fixture bytes touched per op, 0 if not meaningful
+    double ns_per_op;
+    double alloc_bytes_per_op;
+    double allocs_per_op;
+};
+
+struct BenchOptions{
+    std::string filter;
+    std::string json_path;
+    double min_time_ms = 200.0;
+    bool large = false;
+};
+
+class BenchRunner{
+    public :
+        explicit BenchRunner(const BenchOptions& options) : options(options){}
+
+        void run(const std::string& name, uint64_t bytes_processed, const std::function<void()>& op){
+            if (!options.filter.empty() && name.find(options.filter) == std::string::npos) {
+                return;
+            }
+
+            // Warm up and size the batch so a single timed batch covers min_time_ms
+            op();
+            uint64_t iterations = 1;
+            double elapsed_ns = 0;
+            for (;;) {
+                elapsed_ns = time_batch(op, iterations);
+                if (elapsed_ns >= options.min_time_ms * 1e6 || iterations >= (1ULL << 30)) {
+                    break;
+                }
+                double scale = elapsed_ns > 0 ? (options.min_time_ms * 1e6 * 1.2) / elapsed_ns : 10.0;
+                uint64_t next = (uint64_t)(iterations * (scale < 10.0 ? scale : 10.0));
+                iterations = next > iterations ? next : iterations + 1;
+            }
+
+            // Allocation counts are taken from a separate single op so the counters
+            // don't depend on how many iterations the timer settled on
+            uint64_t count_before = g_alloc_count;
+            uint64_t bytes_before = g_alloc_bytes;
+            op();
+            uint64_t allocs = g_alloc_count - count_before;
+            uint64_t alloc_bytes = g_alloc_bytes - bytes_before;
+
+            BenchResult result;
+            result.name = name;
+            result.iterations = iterations;
+            result.bytes_processed = bytes_processed;
+            result.ns_per_op = elapsed_ns / iterations;
+            result.alloc_bytes_per_op = kCountsAllocations ? (double)alloc_bytes : -1;
+            result.allocs_per_op = kCountsAllocations ? (double)allocs : -1;
+            results.push_back(result);
+            print(result);
+        }
+
+        bool write_json() const{
+            if (options.json_path.empty()) {
+                return true;
+            }
+
+            rapidjson::StringBuffer buffer;
+            rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+            writer.StartObject();
+            writer.Key("schema");
+            writer.String("docker-cpp-bench/1");
+            writer.Key("allocations_counted");
+            writer.Bool(kCountsAllocations);
+            writer.Key("benchmarks");
+            writer.StartArray();
+            for (const auto& result : results) {
+                writer.StartObject();
+                writer.Key("name");
+                writer.String(result.name);
+                writer.Key("iterations");
+                writer.Uint64(result.iterations);
+                writer.Key("bytes_processed");
+                writer.Uint64(result.bytes_processed);
+                writer.Key("ns_per_op");
+                writer.Double(result.ns_per_op);
+                writer.Key("alloc_bytes_per_op");
+                writer.Double(result.alloc_bytes_per_op);
+                writer.Key("allocs_per_op");
+                writer.Double(result.allocs_per_op);
+                writer.EndObject();
+            }
+            writer.EndArray();
+            writer.EndObject();
+
+            std::ofstream out(options.json_path.c_str(), std::ios::binary);
+            if (!out) {
+                return false;
+            }
+            out.write(buffer.GetString(), buffer.GetSize());
+            out << "\n";
+            return out.good();
+        }
+
+    private:
+        BenchOptions options;
+        std::vector<BenchResult> results;
+
+        static double time_batch(const std::function<void()>& op, uint64_t iterations){
+            auto start = std::chrono::steady_clock::now();
+            for (uint64_t i = 0; i < iterations; i++) {
+                op();
+            }
+            auto end = std::chrono::steady_clock::now();
+            return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        }
+
+        static void print(const BenchResult& result){
+            double mb_per_s = result.bytes_processed ? (result.bytes_processed / (result.ns_per_op / 1e9)) / (1024.0 * 1024.0) : 0;
+            printf("%-44s %12.1f ns/op %14.0f B/op %10.0f allocs/op", result.name.c_str(), result.ns_per_op, result.alloc_bytes_per_op, result.allocs_per_op);
+            if (result.bytes_processed) {
+                printf(" %10.1f MB/s", mb_per_s);
+            }
+            printf("\n");
+            fflush(stdout);
+        }
+};
+
+static std::string size_label(size_t bytes){
+    char label[32];
+    if (bytes >= (1ULL << 30)) {
+        snprintf(label, sizeof(label), "%zuGB", bytes >> 30);
+    } else if (bytes >= (1ULL << 20)) {
+        snprintf(label, sizeof(label), "%zuMB", bytes >> 20);
+    } else {
+        snprintf(label, sizeof(label), "%zuKB", bytes >> 10);
+    }
+    return label;
+}
+
+/*
+* Benchmarks
+*/
+
+using docker_detail::buildResponse;
+using docker_detail::parseJsonResponse;
+using docker_detail::buildCreateParams;
+using docker_detail::parseDockerLogs;
+using docker_detail::RequestUrl;
+namespace endpoints = docker_detail::endpoints;
+
+static void bench_parse_docker_logs(BenchRunner& runner, bool large){
+    std::vector<size_t> sizes = {4ULL << 10, 1ULL << 20, 64ULL << 20};
+    if (large) {
+        sizes.push_back(1ULL << 30);
+    }
+
+    for (size_t size : sizes) {
+        std::string logs = make_multiplexed_logs(size);
+        uint64_t seen = 0;
+        OutputCallback on_stdout = [&seen](const std::string& data) { seen += data.size(); };
+        ErrorCallback on_stderr = [&seen](const std::string& data) { seen += data.size(); };
+
+        runner.run("parse_docker_logs/" + size_label(size), logs.size(), [&]() {
+            parseDockerLogs(logs, on_stdout, on_stderr);
+        });
+        g_sink += seen;
+    }
+}
+
+static void bench_json(BenchRunner& runner){
+    const size_t counts[] = {10, 1000, 50000};
+
+    for (size_t count : counts) {
+        std::string body = make_containers_json(count);
+        std::string suffix = "/containers=" + std::to_string(count);
+
+        // What requestAndParse does with a JSON endpoint's body once curl returns (buildResponse, then parseJsonResponse)
+        runner.run("parse_response" + suffix, body.size(), [&]() {
+            JSON_DOCUMENT raw = buildResponse(200, 200, body);
+            JSON_DOCUMENT doc = parseJsonResponse(raw);
+            g_sink += doc["data"].Size();
+        });
+
+        JSON_DOCUMENT raw = buildResponse(200, 200, body);
+        JSON_DOCUMENT doc = parseJsonResponse(raw);
+        runner.run("jsonToString" + suffix, body.size(), [&]() {
+            g_sink += jsonToString(doc).size();
+        });
+    }
+}
+
+static void bench_params(BenchRunner& runner){
+    JSON_DOCUMENT filters(rapidjson::kObjectType);
+    JSON_VALUE status(rapidjson::kArrayType);
+    status.PushBack("running", filters.GetAllocator());
+    status.PushBack("paused", filters.GetAllocator());
+    filters.AddMember("status", status, filters.GetAllocator());
+    JSON_VALUE label(rapidjson::kArrayType);
+    label.PushBack("com.docker.compose.project=control-plane", filters.GetAllocator());
+    filters.AddMember("label", label, filters.GetAllocator());
+
+    const std::string since = "4fa6e0f0c678";
+    const std::string empty;
+
+    // Free param() helpers, as a caller assembling its own query would use them
+    runner.run("param/list_containers_query", 0, [&]() {
+        std::string path = "/containers/json?";
+        path += param("all", true);
+        path += param("limit", 50);
+        path += param("since", since);
+        path += param("before", empty);
+        path += param("size", -1);
+        path += param("filters", filters);
+        g_sink += path.size();
+    });
+
+    runner.run("param/logs_query", 0, [&]() {
+        std::string path = "/containers/" + since + "/logs?";
+        path += param("follow", false);
+        path += param("stdout", true);
+        path += param("stderr", true);
+        path += param("timestamps", false);
+        path += param("tail", "all");
+        g_sink += path.size();
+    });
+
+    // Same sequences list_containers / stop_container format through the real endpoint table
+    const std::string host = "http:/v1.24";
+    const std::string container_id = "5d271b3a52263330348b71948bd25cda455a49f7e7d69cfc73e6b2f3b5b41a4c";
+
+    runner.run("request_url/list_containers", 0, [&]() {
+        RequestUrl url(host, endpoints::list_containers);
+        url.param("all", true);
+        url.param("limit", 50);
+        url.param("since", since);
+        url.param("before", empty);
+        url.param("size", -1);
+        url.param("filters", filters);
+        g_sink += (uint64_t)url.c_str()[0];
+    });
+
+    runner.run("request_url/stop_container", 0, [&]() {
+        RequestUrl url(host, endpoints::stop_container, container_id);
+        url.param("t", 10);
+        g_sink += (uint64_t)url.c_str()[0];
+    });
+}
+
+static void bench_create_params(BenchRunner& runner){
+    std::vector<std::string> short_command = {"sh", "-c", "echo hello"};
+    std::vector<std::string> long_command;
+    for (int i = 0; i < 64; i++) {
+        long_command.push_back("--arg-" + std::to_string(i) + "=value");
+    }
+
+    runner.run("create_params/args=3", 0, [&]() {
+        JSON_DOCUMENT doc = buildCreateParams("ubuntu:latest", short_command);
+        g_sink += doc.MemberCount();
+    });
+    runner.run("create_params/args=64", 0, [&]() {
+        JSON_DOCUMENT doc = buildCreateParams("ubuntu:latest", long_command);
+        g_sink += doc.MemberCount();
+    });
+    runner.run("create_params/args=64+serialize", 0, [&]() {
+        JSON_DOCUMENT doc = buildCreateParams("ubuntu:latest", long_command);
+        g_sink += jsonToString(doc).size();
+    });
+}
+
+int main(int argc, char** argv){
+    BenchOptions options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--json" && i + 1 < argc) {
+            options.json_path = argv[++i];
+        } else if (arg == "--filter" && i + 1 < argc) {
+            options.filter = argv[++i];
+        } else if (arg == "--min-time" && i + 1 < argc) {
+            options.min_time_ms = atof(argv[++i]);
+        } else if (arg == "--large") {
+            options.large = true;
+        } else {
+            fprintf(stderr, "usage: %s [--json <file>] [--filter <substr>] [--min-time <ms>] [--large]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    BenchRunner runner(options);
+
+    bench_parse_docker_logs(runner, options.large);
+    bench_json(runner);
+    bench_params(runner);
+    bench_create_params(runner);
+
+    if (!runner.write_json()) {
+        fprintf(stderr, "failed to write %s\n", options.json_path.c_str());
+        return 1;
+    }
+    return 0;
+}
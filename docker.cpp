@@ -24,7 +24,8 @@ int main(){
 Object o; (rapidjson::Document)
  - success        [bool]                  : if succeeded to request
  - data           [Object/Array/string]   : actual data by server (data type depends on API, but it would be Object if 'success' is false)
- - code(optional) [int]                   : http status code if 'success' is false
+ - code(optional) [int]                   : http status code if 'success' is false (0 if no response was received)
+ - error(optional) [string]               : timeout / stalled / cancelled / connection / transport / init, if no response was received
 
 e.g.
 {
@@ -47,9 +48,18 @@ e.g.
 
 ****/
 
-#include "docker.h"
+#include "docker_internal.h"
 #include <utility>
 #include <sstream>
+#include <chrono>
+
+using docker_detail::buildResponse;
+using docker_detail::parseJsonResponse;
+using docker_detail::buildCreateParams;
+using docker_detail::parseDockerLogs;
+using docker_detail::Endpoint;
+using docker_detail::RequestUrl;
+namespace endpoints = docker_detail::endpoints;
 
 /*
 *  
@@ -58,6 +68,27 @@ e.g.
 */
 JSON_DOCUMENT Docker::emptyDoc = JSON_DOCUMENT();
 
+// Never cancelled; lets cleanup requests opt out of a caller's or client-wide token
+static CancellationToken uncancellable;
+// Deadline for best-effort cleanup after a failed call
+static const long CLEANUP_TIMEOUT_MS = 2000;
+// Guards Docker::default_options; shared by every client so Docker stays copyable
+static std::mutex defaultOptionsLock;
+
+// Header lists never change, so they are built once, shared by every request and freed at exit
+static struct RequestHeaders{
+    struct curl_slist *json;
+    struct curl_slist *raw;
+
+    RequestHeaders()
+        : json(curl_slist_append(curl_slist_append(nullptr, "Accept: application/json"), "Content-Type: application/json")),
+          raw(curl_slist_append(nullptr, "Content-Type: application/json")){}
+    ~RequestHeaders(){
+        curl_slist_free_all(json);
+        curl_slist_free_all(raw);
+    }
+} requestHeaders;
+
 Docker::Docker() : host_uri("http:/v1.24"){
     curl_global_init(CURL_GLOBAL_ALL);
     is_remote = false;
@@ -81,108 +112,109 @@ Docker::~Docker(){
 /*
 * System
 */
-JSON_DOCUMENT Docker::system_info(){
-    std::string path = "/info";
-    return requestAndParseJson(GET,path);
+JSON_DOCUMENT Docker::system_info(const RequestOptions& options){
+    RequestUrl url(host_uri, endpoints::system_info);
+    return requestAndParse(endpoints::system_info, url, emptyDoc, options);
 }
-JSON_DOCUMENT Docker::docker_version(){
-    std::string path = "/version";
-    return requestAndParseJson(GET,path);
+JSON_DOCUMENT Docker::docker_version(const RequestOptions& options){
+    RequestUrl url(host_uri, endpoints::docker_version);
+    return requestAndParse(endpoints::docker_version, url, emptyDoc, options);
 }
 
 /*
 * Images
 */
-JSON_DOCUMENT Docker::list_images(){
-    std::string path = "/images/json";
-    return requestAndParseJson(GET,path);
+JSON_DOCUMENT Docker::list_images(const RequestOptions& options){
+    RequestUrl url(host_uri, endpoints::list_images);
+    return requestAndParse(endpoints::list_images, url, emptyDoc, options);
 }
 
 /*
 * Containers
 */
-JSON_DOCUMENT Docker::list_containers(bool all, int limit, const std::string& since, const std::string& before, int size, JSON_DOCUMENT& filters){
-    std::string path = "/containers/json?";
-    path += param("all", all);
-    path += param("limit", limit);
-    path += param("since", since);
-    path += param("before", before);
-    path += param("size", size);
-    path += param("filters", filters);
-    return requestAndParseJson(GET,path);
-}
-JSON_DOCUMENT Docker::inspect_container(const std::string& container_id){
-    std::string path = "/containers/" + container_id + "/json";
-    return requestAndParseJson(GET,path);
-}
-JSON_DOCUMENT Docker::top_container(const std::string& container_id){
-    std::string path = "/containers/" + container_id + "/top";
-    return requestAndParseJson(GET,path);
-}
-JSON_DOCUMENT Docker::logs_container(const std::string& container_id, bool follow, bool o_stdout, bool o_stderr, bool timestamps, const std::string& tail){
-    std::string path = "/containers/" + container_id + "/logs?";
-    path += param("follow", follow);
-    path += param("stdout", o_stdout);
-    path += param("stderr", o_stderr);
-    path += param("timestamps", timestamps);
-    path += param("tail", tail);
-    return requestAndParse(GET,path,200);
-}
-JSON_DOCUMENT Docker::create_container(JSON_DOCUMENT& parameters, const std::string& name){
-    std::string path = "/containers/create";
-    path += not name.empty() ? "?name=" + name : "";
-    return requestAndParseJson(POST,path,201,parameters);
-}
-JSON_DOCUMENT Docker::start_container(const std::string& container_id){
-    std::string path = "/containers/" + container_id + "/start";
-    return requestAndParse(POST,path,204);
-}
-JSON_DOCUMENT Docker::get_container_changes(const std::string& container_id){
-    std::string path = "/containers/" + container_id + "/changes";
-    return requestAndParseJson(GET,path);
-}
-JSON_DOCUMENT Docker::stop_container(const std::string& container_id, int delay){
-    std::string path = "/containers/" + container_id + "/stop?";
-    path += param("t", delay);
-    return requestAndParse(POST,path,204);
-}
-JSON_DOCUMENT Docker::kill_container(const std::string& container_id, int signal){
-    std::string path = "/containers/" + container_id + "/kill?";
-    path += param("signal", signal);
-    return requestAndParse(POST,path,204);
-}
-JSON_DOCUMENT Docker::pause_container(const std::string& container_id){
-    std::string path = "/containers/" + container_id + "/pause";
-    return requestAndParse(POST,path,204);
-}
-JSON_DOCUMENT Docker::wait_container(const std::string& container_id){
-    std::string path = "/containers/" + container_id + "/wait";
-    return requestAndParseJson(POST,path);
-}
-JSON_DOCUMENT Docker::delete_container(const std::string& container_id, bool v, bool force){
-    std::string path = "/containers/" + container_id + "?";
-    path += param("v", v);
-    path += param("force", force);
-    return requestAndParse(DELETE,path,204);
-}
-JSON_DOCUMENT Docker::unpause_container(const std::string& container_id){
-    std::string path = "/containers/" + container_id + "/unpause?";
-    return requestAndParse(POST,path,204);
-}
-JSON_DOCUMENT Docker::restart_container(const std::string& container_id, int delay){
-    std::string path = "/containers/" + container_id + "/restart?";
-    path += param("t", delay);
-    return requestAndParse(POST,path,204);
-}
-JSON_DOCUMENT Docker::attach_to_container(const std::string& container_id, bool logs, bool stream, bool o_stdin, bool o_stdout, bool o_stderr){
-    std::string path = "/containers/" + container_id + "/attach?";
-    path += param("logs", logs);
-    path += param("stream", stream);
-    path += param("stdin", o_stdin);
-    path += param("stdout", o_stdout);
-    path += param("stderr", o_stderr);
-
-    return requestAndParse(POST,path,101);
+JSON_DOCUMENT Docker::list_containers(bool all, int limit, const std::string& since, const std::string& before, int size, JSON_DOCUMENT& filters, const RequestOptions& options){
+    RequestUrl url(host_uri, endpoints::list_containers);
+    url.param("all", all);
+    url.param("limit", limit);
+    url.param("since", since);
+    url.param("before", before);
+    url.param("size", size);
+    url.param("filters", filters);
+    return requestAndParse(endpoints::list_containers, url, emptyDoc, options);
+}
+JSON_DOCUMENT Docker::inspect_container(const std::string& container_id, const RequestOptions& options){
+    RequestUrl url(host_uri, endpoints::inspect_container, container_id);
+    return requestAndParse(endpoints::inspect_container, url, emptyDoc, options);
+}
+JSON_DOCUMENT Docker::top_container(const std::string& container_id, const RequestOptions& options){
+    RequestUrl url(host_uri, endpoints::top_container, container_id);
+    return requestAndParse(endpoints::top_container, url, emptyDoc, options);
+}
+JSON_DOCUMENT Docker::logs_container(const std::string& container_id, bool follow, bool o_stdout, bool o_stderr, bool timestamps, const std::string& tail, const RequestOptions& options){
+    const Endpoint& endpoint = follow ? endpoints::follow_logs_container : endpoints::logs_container;
+    RequestUrl url(host_uri, endpoint, container_id);
+    url.param("follow", follow);
+    url.param("stdout", o_stdout);
+    url.param("stderr", o_stderr);
+    url.param("timestamps", timestamps);
+    url.param("tail", tail);
+    return requestAndParse(endpoint, url, emptyDoc, options);
+}
+JSON_DOCUMENT Docker::create_container(JSON_DOCUMENT& parameters, const std::string& name, const RequestOptions& options){
+    RequestUrl url(host_uri, endpoints::create_container);
+    url.param("name", name);
+    return requestAndParse(endpoints::create_container, url, parameters, options);
+}
+JSON_DOCUMENT Docker::start_container(const std::string& container_id, const RequestOptions& options){
+    RequestUrl url(host_uri, endpoints::start_container, container_id);
+    return requestAndParse(endpoints::start_container, url, emptyDoc, options);
+}
+JSON_DOCUMENT Docker::get_container_changes(const std::string& container_id, const RequestOptions& options){
+    RequestUrl url(host_uri, endpoints::get_container_changes, container_id);
+    return requestAndParse(endpoints::get_container_changes, url, emptyDoc, options);
+}
+JSON_DOCUMENT Docker::stop_container(const std::string& container_id, int delay, const RequestOptions& options){
+    RequestUrl url(host_uri, endpoints::stop_container, container_id);
+    url.param("t", delay);
+    return requestAndParse(endpoints::stop_container, url, emptyDoc, options);
+}
+JSON_DOCUMENT Docker::kill_container(const std::string& container_id, int signal, const RequestOptions& options){
+    RequestUrl url(host_uri, endpoints::kill_container, container_id);
+    url.param("signal", signal);
+    return requestAndParse(endpoints::kill_container, url, emptyDoc, options);
+}
+JSON_DOCUMENT Docker::pause_container(const std::string& container_id, const RequestOptions& options){
+    RequestUrl url(host_uri, endpoints::pause_container, container_id);
+    return requestAndParse(endpoints::pause_container, url, emptyDoc, options);
+}
+JSON_DOCUMENT Docker::wait_container(const std::string& container_id, const RequestOptions& options){
+    RequestUrl url(host_uri, endpoints::wait_container, container_id);
+    return requestAndParse(endpoints::wait_container, url, emptyDoc, options);
+}
+JSON_DOCUMENT Docker::delete_container(const std::string& container_id, bool v, bool force, const RequestOptions& options){
+    RequestUrl url(host_uri, endpoints::delete_container, container_id);
+    url.param("v", v);
+    url.param("force", force);
+    return requestAndParse(endpoints::delete_container, url, emptyDoc, options);
+}
+JSON_DOCUMENT Docker::unpause_container(const std::string& container_id, const RequestOptions& options){
+    RequestUrl url(host_uri, endpoints::unpause_container, container_id);
+    return requestAndParse(endpoints::unpause_container, url, emptyDoc, options);
+}
+JSON_DOCUMENT Docker::restart_container(const std::string& container_id, int delay, const RequestOptions& options){
+    RequestUrl url(host_uri, endpoints::restart_container, container_id);
+    url.param("t", delay);
+    return requestAndParse(endpoints::restart_container, url, emptyDoc, options);
+}
+JSON_DOCUMENT Docker::attach_to_container(const std::string& container_id, bool logs, bool stream, bool o_stdin, bool o_stdout, bool o_stderr, const RequestOptions& options){
+    RequestUrl url(host_uri, endpoints::attach_to_container, container_id);
+    url.param("logs", logs);
+    url.param("stream", stream);
+    url.param("stdin", o_stdin);
+    url.param("stdout", o_stdout);
+    url.param("stderr", o_stderr);
+
+    return requestAndParse(endpoints::attach_to_container, url, emptyDoc, options);
 }
 //void Docker::copy_from_container(const std::string& container_id, const std::string& file_path, const std::string& dest_tar_file){}
 
@@ -193,34 +225,44 @@ JSON_DOCUMENT Docker::attach_to_container(const std::string& container_id, bool
 std::string Docker::run_container_async(
     const std::string& image,
     const std::vector<std::string>& command,
-    const std::string& container_name
+    const std::string& container_name,
+    const RequestOptions& options
 ) {
     try {
+        // One deadline covers create + start instead of each call getting the full timeout
+        RequestOptions step = options;
+        long budget = resolveOptions(options, false).timeout_ms;
+        auto started = std::chrono::steady_clock::now();
+        auto remaining = [&]() -> long {
+            return budget - (long)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started).count();
+        };
+
         // 1. Create container
-        JSON_DOCUMENT create_params(rapidjson::kObjectType);
-        create_params.AddMember("Image", rapidjson::Value(image.c_str(), create_params.GetAllocator()), create_params.GetAllocator());
-        
-        // Set command
-        if (!command.empty()) {
-            JSON_VALUE commands(rapidjson::kArrayType);
-            for (const auto& cmd : command) {
-                commands.PushBack(rapidjson::Value(cmd.c_str(), create_params.GetAllocator()), create_params.GetAllocator());
-            }
-            create_params.AddMember("Cmd", commands, create_params.GetAllocator());
-        }
+        JSON_DOCUMENT create_params = buildCreateParams(image, command);
         
         // Create with optional name
-        JSON_DOCUMENT create_result = create_container(create_params, container_name);
+        if (budget > 0) step.timeout_ms = budget;
+        JSON_DOCUMENT create_result = create_container(create_params, container_name, step);
         if (!create_result.HasMember("success") || !create_result["success"].GetBool()) {
             return ""; // Failed to create
         }
         
         std::string container_id = create_result["data"]["Id"].GetString();
         
-        // 2. Start container
-        JSON_DOCUMENT start_result = start_container(container_id);
-        if (!start_result.HasMember("success") || !start_result["success"].GetBool()) {
-            delete_container(container_id, false, true); // cleanup
+        // 2. Start container, unless create already used up the budget
+        bool started_ok = false;
+        long left = budget > 0 ? remaining() : 0;
+        if (budget <= 0 || left > 0) {
+            if (budget > 0) step.timeout_ms = left;
+            JSON_DOCUMENT start_result = start_container(container_id, step);
+            started_ok = start_result.HasMember("success") && start_result["success"].GetBool();
+        }
+        if (!started_ok) {
+            // Cleanup must reach the daemon even if start failed because of the deadline or a cancel
+            RequestOptions cleanup = resolveOptions(options, false);
+            cleanup.timeout_ms = CLEANUP_TIMEOUT_MS;
+            cleanup.cancel = &uncancellable;
+            delete_container(container_id, false, true, cleanup);
             return ""; // Failed to start
         }
         
@@ -234,7 +276,8 @@ std::string Docker::run_container_async(
 bool Docker::attach_log_stream(
     const std::string& container_id,
     OutputCallback on_stdout,
-    ErrorCallback on_stderr
+    ErrorCallback on_stderr,
+    const RequestOptions& options
 ) {
     if (container_id.empty() || (!on_stdout && !on_stderr)) {
         return false;
@@ -249,7 +292,7 @@ bool Docker::attach_log_stream(
         // Get logs using the existing logs_container method
         // Note: This is a simplified implementation - in a real implementation,
         // you'd want to use Docker's attach API with streaming for real-time logs
-        JSON_DOCUMENT logs = logs_container(container_id, false, true, true, false, "all");
+        JSON_DOCUMENT logs = logs_container(container_id, false, true, true, false, "all", options);
         
         if (logs.HasMember("success") && logs["success"].GetBool() && logs["data"].IsString()) {
             std::string raw_logs(logs["data"].GetString(), logs["data"].GetStringLength());
@@ -265,6 +308,11 @@ bool Docker::attach_log_stream(
     }
 }
 
+void Docker::set_request_options(const RequestOptions& options) {
+    std::lock_guard<std::mutex> guard(defaultOptionsLock);
+    default_options = options;
+}
+
 bool Docker::detach_log_stream(const std::string& container_id) {
     if (container_id.empty()) {
         return false;
@@ -280,33 +328,7 @@ bool Docker::detach_log_stream(const std::string& container_id) {
 }
 
 void Docker::parse_docker_logs(const std::string& raw_logs, OutputCallback on_stdout, ErrorCallback on_stderr) {
-    size_t offset = 0;
-    const char* data = raw_logs.data();
-    size_t total_length = raw_logs.length();
-    
-    while (offset + 8 <= total_length) {
-        // Parse Docker stream format: [stream_type(1)][reserved(3)][length(4)][data(length)]
-        uint8_t stream_type = data[offset];
-        uint32_t msg_length = (((uint8_t)data[offset + 4]) << 24) |
-                             (((uint8_t)data[offset + 5]) << 16) |
-                             (((uint8_t)data[offset + 6]) << 8) |
-                             ((uint8_t)data[offset + 7]);
-        
-        if (offset + 8 + msg_length > total_length) {
-            break; // Incomplete message
-        }
-        
-        std::string message(data + offset + 8, msg_length);
-        
-        // Call appropriate callback based on stream type
-        if (stream_type == 1 && on_stdout) {
-            on_stdout(message);
-        } else if (stream_type == 2 && on_stderr) {
-            on_stderr(message);
-        }
-        
-        offset += 8 + msg_length;
-    }
+    parseDockerLogs(raw_logs, on_stdout, on_stderr);
 }
 
 
@@ -316,91 +338,208 @@ void Docker::parse_docker_logs(const std::string& raw_logs, OutputCallback on_st
 * 
 */
 
-JSON_DOCUMENT Docker::requestAndParse(Method method, const std::string& path, unsigned success_code, JSON_DOCUMENT& param, bool isReturnJson){
+JSON_DOCUMENT Docker::requestAndParse(const Endpoint& endpoint, const RequestUrl& url, JSON_DOCUMENT& param, const RequestOptions& options){
     std::string readBuffer;
-    std::string paramString;
-    std::string method_str;
-    struct curl_slist *headers = nullptr;
-    const char *paramChar;
-    switch(method){
-        case GET:
-            method_str = "GET";
-            break;
-        case POST:
-            method_str = "POST";
-            break;
-        case DELETE:
-            method_str = "DELETE";
-            break;
-        case PUT:
-            method_str = "PUT";
-            break;
-        default:
-            method_str = "GET";
-    }
-
-    curl = curl_easy_init();
-    if(!curl){
-        std::cout << "error while initiating curl" << std::endl;
-        curl_global_cleanup();
-        exit(1);
-    }
-    rapidjson::StringBuffer buffer;
-    buffer.Clear();
-    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-    param.Accept(writer);
-    paramString = std::string(buffer.GetString());
-    paramChar = paramString.c_str();
-    if(isReturnJson)
-        headers = curl_slist_append(headers, "Accept: application/json");
-    headers = curl_slist_append(headers, "Content-Type: application/json");
 
-    //std::cout << "HOST_PATH : " << (host_uri + path) << std::endl;
+    CancellationToken *client_cancel = nullptr;
+    RequestOptions effective = resolveOptions(options, endpoint.streaming, &client_cancel);
+    // Either token aborts the request, so a client-wide cancel() also reaches calls that carry their own.
+    // Cleanup requests pass uncancellable to opt out of both.
+    CancellationToken *call_cancel = effective.cancel;
+    if(call_cancel == &uncancellable)
+        call_cancel = client_cancel = nullptr;
+    if(client_cancel == call_cancel)
+        client_cancel = nullptr;
+    if((call_cancel && call_cancel->is_cancelled()) || (client_cancel && client_cancel->is_cancelled()))
+        return buildError("cancelled", "Request cancelled before it was sent");
+
+    CURL *curl = curl_easy_init();
+    if(!curl)
+        return buildError("init", "Failed to initialize curl handle");
 
     if(!is_remote)
         curl_easy_setopt(curl, CURLOPT_UNIX_SOCKET_PATH, "/var/run/docker.sock");
-    curl_easy_setopt(curl, CURLOPT_URL, (host_uri + path).c_str());
-    curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, method_str.c_str());
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, endpoint.method_name);
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, endpoint.json ? requestHeaders.json : requestHeaders.raw);
     curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
     curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer);
-    if(method == POST){
-        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, paramChar);
-        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, strlen(paramChar));
+
+    // Only serialize a body when there is one; endpoints without parameters POST an empty body
+    rapidjson::StringBuffer buffer;
+    if(endpoint.method == POST){
+        const char *body = "";
+        long bodySize = 0;
+        if(!param.IsNull()){
+            rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+            param.Accept(writer);
+            body = buffer.GetString();
+            bodySize = (long)buffer.GetSize();
+        }
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body);
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, bodySize);
+    }
+
+    // Deadlines and stall detection; NOSIGNAL keeps timeouts safe on multi-threaded callers
+    char errorBuffer[CURL_ERROR_SIZE];
+    errorBuffer[0] = '\0';
+    curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, errorBuffer);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    if(effective.timeout_ms >= 0)
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, effective.timeout_ms);
+    if(effective.connect_timeout_ms >= 0)
+        curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, effective.connect_timeout_ms);
+    if(effective.low_speed_limit > 0 && effective.low_speed_time > 0){
+        curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT, effective.low_speed_limit);
+        curl_easy_setopt(curl, CURLOPT_LOW_SPEED_TIME, effective.low_speed_time);
     }
 
-    res = curl_easy_perform(curl);
-    if(res != CURLE_OK)
-        fprintf(stderr, "curl_easy_perform() failed: %s\n",
-            curl_easy_strerror(res));
-    unsigned status = 0;
-    curl_easy_getinfo (curl, CURLINFO_RESPONSE_CODE, &status);
+    bool cancelled = false;
+    CURLcode res;
+    if(call_cancel || client_cancel)
+        res = performCancellable(curl, call_cancel, client_cancel, cancelled);
+    else
+        res = curl_easy_perform(curl);
+    long status = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+    curl_off_t elapsed_us = 0;
+    curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &elapsed_us);
+    curl_off_t connect_us = 0;
+    curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME_T, &connect_us);
     curl_easy_cleanup(curl);
 
-    const char* buf = readBuffer.c_str();
+    if(cancelled)
+        return buildError("cancelled", "Request cancelled");
+    if(res != CURLE_OK){
+        std::string message = errorBuffer[0] ? errorBuffer : curl_easy_strerror(res);
+        if(res == CURLE_OPERATION_TIMEDOUT){
+            // Connect deadlines, request deadlines and low-speed aborts all report this code.
+            // A zero connect time means the connection was never established.
+            bool connected = connect_us > 0 || status != 0;
+            bool deadline = effective.timeout_ms > 0 && elapsed_us / 1000 >= effective.timeout_ms;
+            if(!connected)
+                return buildError(deadline ? "timeout" : "connection", message);
+            bool stalled = !deadline && effective.low_speed_limit > 0 && effective.low_speed_time > 0;
+            return buildError(stalled ? "stalled" : "timeout", message);
+        }
+        if(res == CURLE_COULDNT_CONNECT || res == CURLE_COULDNT_RESOLVE_HOST)
+            return buildError("connection", message);
+        return buildError("transport", message);
+    }
+
+    JSON_DOCUMENT result = buildResponse((unsigned)status, endpoint.success_code, readBuffer);
+    if(endpoint.json)
+        return parseJsonResponse(result);
+    return result;
+}
+
+RequestOptions Docker::resolveOptions(const RequestOptions& options, bool streaming, CancellationToken **client_cancel) const{
+    // Snapshot the defaults so set_request_options() from another thread can't change them mid-request
+    RequestOptions defaults;
+    {
+        std::lock_guard<std::mutex> guard(defaultOptionsLock);
+        defaults = default_options;
+    }
+
+    RequestOptions resolved = options;
+    if(resolved.timeout_ms < 0)
+        resolved.timeout_ms = streaming ? -1 : defaults.timeout_ms;
+    if(resolved.connect_timeout_ms < 0)
+        resolved.connect_timeout_ms = defaults.connect_timeout_ms;
+    if(resolved.low_speed_limit < 0)
+        resolved.low_speed_limit = streaming ? -1 : defaults.low_speed_limit;
+    if(resolved.low_speed_time < 0)
+        resolved.low_speed_time = streaming ? -1 : defaults.low_speed_time;
+    if(client_cancel)
+        *client_cancel = defaults.cancel;
+    return resolved;
+}
+
+CURLcode Docker::performCancellable(CURL *handle, CancellationToken *token, CancellationToken *client_token, bool& cancelled){
+    CURLM *multi = curl_multi_init();
+    if(!multi)
+        return CURLE_OUT_OF_MEMORY;
+    curl_multi_add_handle(multi, handle);
+    if(token)
+        token->attach(multi);
+    if(client_token)
+        client_token->attach(multi);
+
+    // Stays CURLE_FAILED_INIT only if the multi interface itself fails
+    CURLcode result = CURLE_FAILED_INIT;
+    int running = 1;
+    while(running){
+        if((token && token->is_cancelled()) || (client_token && client_token->is_cancelled())){
+            cancelled = true;
+            result = CURLE_ABORTED_BY_CALLBACK;
+            break;
+        }
+        if(curl_multi_perform(multi, &running) != CURLM_OK)
+            break;
+        // Returns early on socket activity, curl's own timers, or CancellationToken::cancel()
+        if(running && curl_multi_poll(multi, nullptr, 0, 1000, nullptr) != CURLM_OK)
+            break;
+    }
+    if(!cancelled){
+        int queued = 0;
+        CURLMsg *msg;
+        while((msg = curl_multi_info_read(multi, &queued))){
+            if(msg->msg == CURLMSG_DONE && msg->easy_handle == handle)
+                result = msg->data.result;
+        }
+    }
+
+    if(token)
+        token->detach(multi);
+    if(client_token)
+        client_token->detach(multi);
+    curl_multi_remove_handle(multi, handle);
+    curl_multi_cleanup(multi);
+    return result;
+}
+
+JSON_DOCUMENT Docker::buildError(const char* error, const std::string& message){
+    JSON_DOCUMENT doc(rapidjson::kObjectType);
+    doc.AddMember("success", false, doc.GetAllocator());
+    doc.AddMember("code", 0, doc.GetAllocator());
+    doc.AddMember("error", JSON_VALUE(error, doc.GetAllocator()), doc.GetAllocator());
+
+    JSON_VALUE data(rapidjson::kObjectType);
+    data.AddMember("message", JSON_VALUE(message.c_str(), message.length(), doc.GetAllocator()), doc.GetAllocator());
+    doc.AddMember("data", data, doc.GetAllocator());
+    return doc;
+}
+
+/*
+*  
+* END Docker Implementation
+* 
+*/
+
+namespace docker_detail{
+
+JSON_DOCUMENT buildResponse(unsigned status, unsigned success_code, const std::string& body){
     JSON_DOCUMENT doc(rapidjson::kObjectType);
     if(status == success_code || status == 200){
         doc.AddMember("success", true, doc.GetAllocator());
 
         JSON_VALUE dataString;
         // Use the full length to handle binary data correctly (don't rely on null termination)
-        dataString.SetString(readBuffer.c_str(), readBuffer.length(), doc.GetAllocator());
+        dataString.SetString(body.c_str(), body.length(), doc.GetAllocator());
 
         doc.AddMember("data", dataString, doc.GetAllocator());
     }else{
         JSON_DOCUMENT resp(&doc.GetAllocator());
-        resp.Parse(buf);
+        resp.Parse(body.c_str());
 
         doc.AddMember("success", false, doc.GetAllocator());
         doc.AddMember("code", status, doc.GetAllocator());
         doc.AddMember("data", resp, doc.GetAllocator());
     }
-    curl_slist_free_all(headers);
     return doc;
 }
 
-JSON_DOCUMENT Docker::requestAndParseJson(Method method, const std::string& path, unsigned success_code, JSON_DOCUMENT& param){
-    auto result_obj = requestAndParse(method,path,success_code,param,true);
+JSON_DOCUMENT parseJsonResponse(JSON_DOCUMENT& result_obj){
     bool result = (result_obj.HasMember("success") && result_obj["success"].IsBool() && result_obj["success"].GetBool());
     if(result){
         JSON_DOCUMENT doc(rapidjson::kObjectType);
@@ -412,15 +551,158 @@ JSON_DOCUMENT Docker::requestAndParseJson(Method method, const std::string& path
         doc.AddMember("data", data, doc.GetAllocator());
         return doc;
     }else{
-        return result_obj;
+        JSON_DOCUMENT doc;
+        doc.Swap(result_obj);
+        return doc;
     }
 }
 
-/*
-*  
-* END Docker Implementation
-* 
-*/
+JSON_DOCUMENT buildCreateParams(const std::string& image, const std::vector<std::string>& command) {
+    JSON_DOCUMENT create_params(rapidjson::kObjectType);
+    create_params.AddMember("Image", rapidjson::Value(image.c_str(), create_params.GetAllocator()), create_params.GetAllocator());
+    
+    // Set command
+    if (!command.empty()) {
+        JSON_VALUE commands(rapidjson::kArrayType);
+        for (const auto& cmd : command) {
+            commands.PushBack(rapidjson::Value(cmd.c_str(), create_params.GetAllocator()), create_params.GetAllocator());
+        }
+        create_params.AddMember("Cmd", commands, create_params.GetAllocator());
+    }
+    
+    return create_params;
+}
+
+void parseDockerLogs(const std::string& raw_logs, OutputCallback on_stdout, ErrorCallback on_stderr) {
+    size_t offset = 0;
+    const char* data = raw_logs.data();
+    size_t total_length = raw_logs.length();
+    
+    while (offset + 8 <= total_length) {
+        // Parse Docker stream format: [stream_type(1)][reserved(3)][length(4)][data(length)]
+        uint8_t stream_type = data[offset];
+        uint32_t msg_length = (((uint8_t)data[offset + 4]) << 24) |
+                             (((uint8_t)data[offset + 5]) << 16) |
+                             (((uint8_t)data[offset + 6]) << 8) |
+                             ((uint8_t)data[offset + 7]);
+        
+        if (offset + 8 + msg_length > total_length) {
+            break; // Incomplete message
+        }
+        
+        std::string message(data + offset + 8, msg_length);
+        
+        // Call appropriate callback based on stream type
+        if (stream_type == 1 && on_stdout) {
+            on_stdout(message);
+        } else if (stream_type == 2 && on_stderr) {
+            on_stderr(message);
+        }
+        
+        offset += 8 + msg_length;
+    }
+}
+
+RequestUrl::RequestUrl(const std::string& host, const Endpoint& endpoint) : length(0), has_query(false), spilled(false){
+    buffer[0] = '\0';
+    append(host.data(), host.size());
+    append(endpoint.prefix, endpoint.prefix_length);
+    append(endpoint.suffix, endpoint.suffix_length);
+}
+
+RequestUrl::RequestUrl(const std::string& host, const Endpoint& endpoint, const std::string& id) : length(0), has_query(false), spilled(false){
+    buffer[0] = '\0';
+    append(host.data(), host.size());
+    append(endpoint.prefix, endpoint.prefix_length);
+    append(id.data(), id.size());
+    append(endpoint.suffix, endpoint.suffix_length);
+}
+
+void RequestUrl::param(const char* name, const std::string& value){
+    if(!value.empty()){
+        appendName(name);
+        append(value.data(), value.size());
+    }
+}
+
+void RequestUrl::param(const char* name, const char* value){
+    if(value != nullptr){
+        appendName(name);
+        append(value, strlen(value));
+    }
+}
+
+void RequestUrl::param(const char* name, bool value){
+    appendName(name);
+    if(value)
+        append("true", 4);
+    else
+        append("false", 5);
+}
+
+void RequestUrl::param(const char* name, int value){
+    if(value != -1){
+        char digits[16];
+        int size = snprintf(digits, sizeof(digits), "%d", value);
+        appendName(name);
+        append(digits, (size_t)size);
+    }
+}
+
+void RequestUrl::param(const char* name, JSON_DOCUMENT& value){
+    if(value.IsObject()){
+        rapidjson::StringBuffer json;
+        rapidjson::Writer<rapidjson::StringBuffer> writer(json);
+        value.Accept(writer);
+        appendName(name);
+        append(json.GetString(), json.GetSize());
+    }
+}
+
+void RequestUrl::appendName(const char* name){
+    append(has_query ? "&" : "?", 1);
+    has_query = true;
+    append(name, strlen(name));
+    append("=", 1);
+}
+
+void RequestUrl::append(const char* data, size_t size){
+    if(!spilled && length + size < sizeof(buffer)){
+        memcpy(buffer + length, data, size);
+        length += size;
+        buffer[length] = '\0';
+        return;
+    }
+    if(!spilled){
+        spill.assign(buffer, length);
+        spilled = true;
+    }
+    spill.append(data, size);
+}
+
+}
+
+void CancellationToken::cancel(){
+    cancelled = true;
+    std::lock_guard<std::mutex> guard(active_lock);
+    for(CURLM *multi : active)
+        curl_multi_wakeup(multi);
+}
+
+void CancellationToken::attach(CURLM *multi){
+    std::lock_guard<std::mutex> guard(active_lock);
+    active.push_back(multi);
+}
+
+void CancellationToken::detach(CURLM *multi){
+    std::lock_guard<std::mutex> guard(active_lock);
+    for(auto it = active.begin(); it != active.end(); ++it){
+        if(*it == multi){
+            active.erase(it);
+            break;
+        }
+    }
+}
 
 std::string param( const std::string& param_name, const std::string& param_value){
     if(!param_value.empty()){
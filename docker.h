@@ -5,6 +5,8 @@
 #include <functional>
 #include <vector>
 #include <map>
+#include <atomic>
+#include <mutex>
 #include <curl/curl.h>
 #include "rapidjson/document.h"
 #include "rapidjson/prettywriter.h"
@@ -32,6 +34,50 @@ typedef std::function<void(const std::string& data)> OutputCallback;
 typedef std::function<void(const std::string& data)> ErrorCallback;
 typedef std::function<std::string()> InputCallback;
 
+// Defined in docker_internal.h
+namespace docker_detail{
+    struct Endpoint;
+    class RequestUrl;
+}
+
+/*
+* Request deadlines and cancellation
+*/
+
+// Shared between a caller and any thread that may need to abort its requests.
+// cancel() wakes up in-flight requests immediately instead of waiting for curl's next progress tick.
+class CancellationToken{
+    public :
+        CancellationToken() : cancelled(false){}
+        CancellationToken(const CancellationToken&) = delete;
+        CancellationToken& operator=(const CancellationToken&) = delete;
+
+        void cancel();
+        void reset(){ cancelled = false; }
+        bool is_cancelled() const { return cancelled; }
+
+    private:
+        friend class Docker;
+
+        std::atomic<bool> cancelled;
+        std::mutex active_lock;
+        std::vector<CURLM*> active;
+
+        void attach(CURLM *multi);
+        void detach(CURLM *multi);
+};
+
+// -1 leaves a field to the client default (see Docker::set_request_options), 0 disables it.
+// curl can't disable the connect deadline: connect_timeout_ms 0 means curl's built-in 300 s.
+// A per-call cancel token is checked alongside the client-wide one; cancelling either aborts the call.
+struct RequestOptions{
+    long timeout_ms = -1;            // deadline for the whole request
+    long connect_timeout_ms = -1;    // deadline for connecting to the daemon
+    long low_speed_limit = -1;       // stall detection: abort when slower than this many bytes/sec ...
+    long low_speed_time = -1;        // ... for this many seconds
+    CancellationToken *cancel = nullptr;
+};
+
 class Docker{
     public :
         Docker();
@@ -41,68 +87,85 @@ class Docker{
         /*
         * System
         */
-        JSON_DOCUMENT system_info();
-        JSON_DOCUMENT docker_version();
+        JSON_DOCUMENT system_info(const RequestOptions& options=RequestOptions());
+        JSON_DOCUMENT docker_version(const RequestOptions& options=RequestOptions());
 
         /*
         * Images
         */
-        JSON_DOCUMENT list_images();
+        JSON_DOCUMENT list_images(const RequestOptions& options=RequestOptions());
 
         /*
         * Containers
         */
-        JSON_DOCUMENT list_containers(bool all=false, int limit=-1, const std::string& since="", const std::string& before="", int size=-1, JSON_DOCUMENT& filters=emptyDoc);
-        JSON_DOCUMENT inspect_container(const std::string& container_id);
-        JSON_DOCUMENT top_container(const std::string& container_id);
-        JSON_DOCUMENT logs_container(const std::string& container_id, bool follow=false, bool o_stdout=true, bool o_stderr=false, bool timestamps=false, const std::string& tail="all");
-        JSON_DOCUMENT create_container(JSON_DOCUMENT& parameters, const std::string& name="");
-        JSON_DOCUMENT start_container(const std::string& container_id);
-        JSON_DOCUMENT get_container_changes(const std::string& container_id);
-        JSON_DOCUMENT stop_container(const std::string& container_id, int delay=-1);
-        JSON_DOCUMENT kill_container(const std::string& container_id, int signal=-1);
-        JSON_DOCUMENT pause_container(const std::string& container_id);
-        JSON_DOCUMENT wait_container(const std::string& container_id);
-        JSON_DOCUMENT delete_container(const std::string& container_id, bool v=false, bool force=false);
-        JSON_DOCUMENT unpause_container(const std::string& container_id);
-        JSON_DOCUMENT restart_container(const std::string& container_id, int delay=-1);
-        JSON_DOCUMENT attach_to_container(const std::string& container_id, bool logs=false, bool stream=false, bool o_stdin=false, bool o_stdout=false, bool o_stderr=false);
+        JSON_DOCUMENT list_containers(bool all=false, int limit=-1, const std::string& since="", const std::string& before="", int size=-1, JSON_DOCUMENT& filters=emptyDoc, const RequestOptions& options=RequestOptions());
+        JSON_DOCUMENT inspect_container(const std::string& container_id, const RequestOptions& options=RequestOptions());
+        JSON_DOCUMENT top_container(const std::string& container_id, const RequestOptions& options=RequestOptions());
+        JSON_DOCUMENT logs_container(const std::string& container_id, bool follow=false, bool o_stdout=true, bool o_stderr=false, bool timestamps=false, const std::string& tail="all", const RequestOptions& options=RequestOptions());
+        JSON_DOCUMENT create_container(JSON_DOCUMENT& parameters, const std::string& name="", const RequestOptions& options=RequestOptions());
+        JSON_DOCUMENT start_container(const std::string& container_id, const RequestOptions& options=RequestOptions());
+        JSON_DOCUMENT get_container_changes(const std::string& container_id, const RequestOptions& options=RequestOptions());
+        JSON_DOCUMENT stop_container(const std::string& container_id, int delay=-1, const RequestOptions& options=RequestOptions());
+        JSON_DOCUMENT kill_container(const std::string& container_id, int signal=-1, const RequestOptions& options=RequestOptions());
+        JSON_DOCUMENT pause_container(const std::string& container_id, const RequestOptions& options=RequestOptions());
+        JSON_DOCUMENT wait_container(const std::string& container_id, const RequestOptions& options=RequestOptions());
+        JSON_DOCUMENT delete_container(const std::string& container_id, bool v=false, bool force=false, const RequestOptions& options=RequestOptions());
+        JSON_DOCUMENT unpause_container(const std::string& container_id, const RequestOptions& options=RequestOptions());
+        JSON_DOCUMENT restart_container(const std::string& container_id, int delay=-1, const RequestOptions& options=RequestOptions());
+        JSON_DOCUMENT attach_to_container(const std::string& container_id, bool logs=false, bool stream=false, bool o_stdin=false, bool o_stdout=false, bool o_stderr=false, const RequestOptions& options=RequestOptions());
         //void copy_from_container(const std::string& container_id, const std::string& file_path, const std::string& dest_tar_file);
 
         /*
         * High-level container execution and log streaming
         */
         
-        // Convenience method: create and start container in one call
+        // Convenience method: create and start container in one call.
+        // options.timeout_ms bounds create + start together, and start is skipped if create used it all up.
+        // If start fails or is skipped, the container is removed with its own 2 s deadline that ignores
+        // cancellation, so the call can take up to timeout_ms + 2 s in total.
         std::string run_container_async(
             const std::string& image,
             const std::vector<std::string>& command,
-            const std::string& container_name = ""
+            const std::string& container_name = "",
+            const RequestOptions& options = RequestOptions()
         );
         
         // Attach live log streaming (non-blocking, runs callbacks in background)
         bool attach_log_stream(
             const std::string& container_id,
             OutputCallback on_stdout = nullptr,
-            ErrorCallback on_stderr = nullptr
+            ErrorCallback on_stderr = nullptr,
+            const RequestOptions& options = RequestOptions()
         );
         
         // Detach log streaming
         bool detach_log_stream(const std::string& container_id);
 
+        /*
+        * Client-wide defaults for deadlines, stall detection and cancellation
+        */
+        // Safe to call while other threads use the client; requests already in flight keep the defaults they started with
+        void set_request_options(const RequestOptions& options);
+
     private:
         std::string host_uri;
         bool is_remote;
-        CURL *curl{};
-        CURLcode res{};
 
         static JSON_DOCUMENT emptyDoc;
+        RequestOptions default_options;
         
         // Log streaming state
         std::map<std::string, bool> active_log_streams;
 
-        JSON_DOCUMENT requestAndParse(Method method, const std::string& path, unsigned success_code = 200, JSON_DOCUMENT& param=emptyDoc, bool isReturnJson=false);
-        JSON_DOCUMENT requestAndParseJson(Method method, const std::string& path, unsigned success_code = 200, JSON_DOCUMENT& param=emptyDoc);
+        JSON_DOCUMENT requestAndParse(const docker_detail::Endpoint& endpoint, const docker_detail::RequestUrl& url, JSON_DOCUMENT& param=emptyDoc, const RequestOptions& options=RequestOptions());
+
+        // Per-call options with unset fields filled in from default_options (deadlines only for non-streaming endpoints).
+        // cancel stays the per-call token; the client-wide one is returned through client_cancel.
+        RequestOptions resolveOptions(const RequestOptions& options, bool streaming, CancellationToken **client_cancel=nullptr) const;
+        // Runs the transfer on a multi handle so either token (each may be null) can interrupt it mid-poll
+        static CURLcode performCancellable(CURL *handle, CancellationToken *token, CancellationToken *client_token, bool& cancelled);
+        // Failure that never produced an HTTP status (code 0)
+        static JSON_DOCUMENT buildError(const char* error, const std::string& message);
 
         // Helper method to parse Docker's multiplexed log stream
         void parse_docker_logs(const std::string& raw_logs, OutputCallback on_stdout, ErrorCallback on_stderr);
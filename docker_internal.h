@@ -0,0 +1,119 @@
+#ifndef DOCKER_INTERNAL_H
+#define DOCKER_INTERNAL_H
+
+#include "docker.h"
+
+/*
+* Internal helpers
+*
+* Stateless pieces of the client shared by docker.cpp and the benchmarks.
+* This header is not installed; library users only see docker.h.
+* Everything here lives in docker_detail with hidden visibility, so none of it
+* is exported from libdocker-cpp; the benchmarks compile docker.cpp themselves.
+*/
+
+#if defined(__GNUC__)
+#define DOCKER_HIDDEN __attribute__((visibility("hidden")))
+#else
+#define DOCKER_HIDDEN
+#endif
+
+namespace docker_detail DOCKER_HIDDEN {
+
+// Transport-independent halves of requestAndParse: the raw response, then the JSON branch for endpoints with json set
+JSON_DOCUMENT buildResponse(unsigned status, unsigned success_code, const std::string& body);
+JSON_DOCUMENT parseJsonResponse(JSON_DOCUMENT& result_obj);
+
+// Body for POST /containers/create as used by run_container_async
+JSON_DOCUMENT buildCreateParams(const std::string& image, const std::vector<std::string>& command);
+
+// Splits Docker's multiplexed stdout/stderr stream into callbacks
+void parseDockerLogs(const std::string& raw_logs, OutputCallback on_stdout, ErrorCallback on_stderr);
+
+constexpr const char* methodName(Method method){
+    return method == POST ? "POST" : method == DELETE ? "DELETE" : method == PUT ? "PUT" : "GET";
+}
+
+/*
+* Endpoint descriptors
+*
+* One constexpr instance per Engine API endpoint (see the table below).
+* The path is split around the resource id so formatting a request is plain concatenation.
+* Endpoint and RequestUrl are first declared in docker.h, outside this namespace body,
+* so they carry the hidden attribute themselves.
+*/
+struct DOCKER_HIDDEN Endpoint{
+    Method method;
+    const char* method_name;
+    const char* prefix;         // path up to the resource id, or the whole path
+    size_t prefix_length;
+    const char* suffix;         // path after the resource id; never holds the query separator
+    size_t suffix_length;
+    unsigned success_code;
+    bool json;                  // parse the body as JSON, otherwise return it as a raw string
+    bool streaming;             // long-lived response; client-wide deadlines and stall detection don't apply
+
+    template<size_t P, size_t S>
+    constexpr Endpoint(Method method, const char (&prefix)[P], const char (&suffix)[S], unsigned success_code, bool json, bool streaming)
+        : method(method), method_name(methodName(method)),
+          prefix(prefix), prefix_length(P - 1), suffix(suffix), suffix_length(S - 1),
+          success_code(success_code), json(json), streaming(streaming){}
+};
+
+// Request URL formatted into an inline buffer; only spills to the heap for unusually long queries
+class DOCKER_HIDDEN RequestUrl{
+    public :
+        RequestUrl(const std::string& host, const Endpoint& endpoint);
+        RequestUrl(const std::string& host, const Endpoint& endpoint, const std::string& id);
+
+        // Same encoding and skip rules as the free param() functions; the first parameter written opens the query with '?'
+        void param(const char* name, const std::string& value);
+        void param(const char* name, const char* value);
+        void param(const char* name, bool value);
+        void param(const char* name, int value);
+        void param(const char* name, JSON_DOCUMENT& value);
+
+        const char* c_str() const { return spilled ? spill.c_str() : buffer; }
+
+    private:
+        char buffer[512];
+        size_t length;
+        bool has_query;
+        bool spilled;
+        std::string spill;
+
+        void append(const char* data, size_t size);
+        void appendName(const char* name);
+};
+
+/*
+* Endpoint table
+*/
+namespace endpoints{
+    //                                        method  prefix                 suffix       success json   streaming
+    constexpr Endpoint system_info           (GET,    "/info",               "",          200,    true,  false);
+    constexpr Endpoint docker_version        (GET,    "/version",            "",          200,    true,  false);
+
+    constexpr Endpoint list_images           (GET,    "/images/json",        "",          200,    true,  false);
+
+    constexpr Endpoint list_containers       (GET,    "/containers/json",    "",          200,    true,  false);
+    constexpr Endpoint inspect_container     (GET,    "/containers/",        "/json",     200,    true,  false);
+    constexpr Endpoint top_container         (GET,    "/containers/",        "/top",      200,    true,  false);
+    constexpr Endpoint logs_container        (GET,    "/containers/",        "/logs",     200,    false, false);
+    constexpr Endpoint follow_logs_container (GET,    "/containers/",        "/logs",     200,    false, true);
+    constexpr Endpoint create_container      (POST,   "/containers/create",  "",          201,    true,  false);
+    constexpr Endpoint start_container       (POST,   "/containers/",        "/start",    204,    false, false);
+    constexpr Endpoint get_container_changes (GET,    "/containers/",        "/changes",  200,    true,  false);
+    constexpr Endpoint stop_container        (POST,   "/containers/",        "/stop",     204,    false, false);
+    constexpr Endpoint kill_container        (POST,   "/containers/",        "/kill",     204,    false, false);
+    constexpr Endpoint pause_container       (POST,   "/containers/",        "/pause",    204,    false, false);
+    constexpr Endpoint wait_container        (POST,   "/containers/",        "/wait",     200,    true,  true);
+    constexpr Endpoint delete_container      (DELETE, "/containers/",        "",          204,    false, false);
+    constexpr Endpoint unpause_container     (POST,   "/containers/",        "/unpause",  204,    false, false);
+    constexpr Endpoint restart_container     (POST,   "/containers/",        "/restart",  204,    false, false);
+    constexpr Endpoint attach_to_container   (POST,   "/containers/",        "/attach",   101,    false, true);
+}
+
+}
+
+#endif